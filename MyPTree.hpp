@@ -1,9 +1,14 @@
 #ifndef MY_PTREE_HPP_INCLUDED
 #define MY_PTREE_HPP_INCLUDED
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <memory>
 #include <queue>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -11,11 +16,13 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include "PTreeTranslators.hpp"
 #include "PTreeUtils.hpp"
 
 // Forward declarations.
 struct StringToMyData;
 struct MyDataToString;
+template<typename T> struct MyDataTranslator;
 
 class MyData
 {
@@ -45,6 +52,7 @@ private:
 
     friend struct StringToMyData;
     friend struct MyDataToString;
+    template<typename T> friend struct MyDataTranslator;
 };
 
 
@@ -92,6 +100,82 @@ struct MyDataToString
     }
 };
 
+/**
+ * @brief Translates between MyData and arithmetic values using the
+ *        locale-free FastTranslator. Reading a value counts as a hit.
+ *        Pass it explicitly, e.g. pt.get<int>("a", MyDataTranslator<int>()),
+ *        unless PTREE_UTILS_FAST_TRANSLATOR_DEFAULT is defined.
+ */
+template<typename T>
+struct MyDataTranslator
+{
+    typedef MyData internal_type;
+    typedef T      external_type;
+
+    // Converts MyData to a number.
+    boost::optional<external_type> get_value(const internal_type& d) const
+    {
+        ++(*d.hits_);
+        return FastTranslator<T>().get_value(d.data_);
+    }
+
+    // Converts a number to MyData.
+    boost::optional<internal_type> put_value(const external_type& t) const
+    {
+        const auto s = FastTranslator<T>().put_value(t);
+        if (!s)
+        {
+            return boost::optional<internal_type>();
+        }
+        return boost::optional<internal_type>(MyData(*s));
+    }
+};
+
+namespace ptree_utils {
+namespace detail {
+
+template<typename T>
+struct ValueTranslator<MyData, T,
+                       typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    typedef MyDataTranslator<T> type;
+};
+
+} // namespace detail
+} // namespace ptree_utils
+
+#ifdef PTREE_UTILS_FAST_TRANSLATOR_DEFAULT
+
+#define MY_DATA_TRANSLATOR(T)                                                 \
+    template<>                                                                \
+    struct translator_between<MyData, T>                                      \
+    {                                                                         \
+        typedef MyDataTranslator<T> type;                                     \
+    };
+
+namespace boost {
+namespace property_tree {
+
+MY_DATA_TRANSLATOR(bool)
+MY_DATA_TRANSLATOR(short)
+MY_DATA_TRANSLATOR(unsigned short)
+MY_DATA_TRANSLATOR(int)
+MY_DATA_TRANSLATOR(unsigned int)
+MY_DATA_TRANSLATOR(long)
+MY_DATA_TRANSLATOR(unsigned long)
+MY_DATA_TRANSLATOR(long long)
+MY_DATA_TRANSLATOR(unsigned long long)
+MY_DATA_TRANSLATOR(float)
+MY_DATA_TRANSLATOR(double)
+MY_DATA_TRANSLATOR(long double)
+
+} // namespace property_tree
+} // namespace boost
+
+#undef MY_DATA_TRANSLATOR
+
+#endif // PTREE_UTILS_FAST_TRANSLATOR_DEFAULT
+
 namespace boost {
 namespace property_tree {
 
@@ -116,6 +200,8 @@ std::vector<MyPTree::key_type> untouchedKeys(const MyPTree& pt)
 {
     using namespace std;
 
+    PTREE_STATS_SCOPE(PTREE_OP_UNTOUCHED_KEYS);
+
     vector<MyPTree::key_type> untouched_keys;
 
     // Setup a queue of children for traversal of tree.
@@ -137,9 +223,12 @@ std::vector<MyPTree::key_type> untouchedKeys(const MyPTree& pt)
 
             const auto sub_path = path / MyPTree::path_type(sub_key);
 
+            PTREE_STATS_NODES(PTREE_OP_UNTOUCHED_KEYS, 1);
+
             if (isLeafTree(sub_tree))
             {
                 const auto data = sub_tree.get_value<MyPTree::data_type>();
+                PTREE_STATS_LOOKUP(PTREE_OP_UNTOUCHED_KEYS, data.hits() > 0);
                 if (data.hits() == 0)
                 {
                     untouched_keys.push_back(sub_path.dump());
@@ -153,6 +242,8 @@ std::vector<MyPTree::key_type> untouchedKeys(const MyPTree& pt)
                      ++sub_iter, ++index)
                 {
                     const auto data = sub_tree.get_value<MyPTree::data_type>();
+                    PTREE_STATS_NODES(PTREE_OP_UNTOUCHED_KEYS, 1);
+                    PTREE_STATS_LOOKUP(PTREE_OP_UNTOUCHED_KEYS, data.hits() > 0);
                     if (data.hits() == 0)
                     {
                         stringstream ss;
@@ -173,4 +264,219 @@ std::vector<MyPTree::key_type> untouchedKeys(const MyPTree& pt)
     return untouched_keys;
 }
 
+/**
+ * @brief Number of times the value at @a path has been read.
+ */
+struct AccessCount
+{
+    std::string path;
+    std::size_t hits;
+};
+
+namespace ptree_utils {
+namespace detail {
+
+typedef std::vector<PathElement<MyPTree::key_type>> MyPTreePath;
+
+/**
+ * @brief Depth-first traversal calling @a visit(path, hits) for every leaf
+ *        value. Unlike untouchedKeys() no sub-trees are copied and no path
+ *        strings are built, @a path refers to keys in @a tree.
+ */
+template<typename Visitor>
+void visitAccessCounts(const MyPTree& tree, MyPTreePath& path, Visitor& visit)
+{
+    std::size_t index = 0;
+    const auto iend = tree.end();
+    for (auto iter = tree.begin(); iter != iend; ++iter, ++index)
+    {
+        const PathElement<MyPTree::key_type> element = { &iter->first, index };
+        path.push_back(element);
+        if (isLeafTree(iter->second))
+        {
+            visit(path, iter->second.data().hits());
+        }
+        else
+        {
+            visitAccessCounts(iter->second, path, visit); // Recursive!
+        }
+        path.pop_back();
+    }
+}
+
+// Most hits first, ties in traversal order.
+inline bool moreAccessed(const AccessCount& lhs, const AccessCount& rhs)
+{
+    return lhs.hits > rhs.hits;
+}
+
+inline void writeJsonString(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+        const char c = s[i];
+        if (c == '"' || c == '\\')
+        {
+            os << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            const char* hex = "0123456789abcdef";
+            os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+        }
+        else
+        {
+            os << c;
+        }
+    }
+    os << '"';
+}
+
+inline void writeFoldedFrame(std::ostream& os, const std::string& key)
+{
+    for (std::size_t i = 0; i < key.size(); ++i)
+    {
+        switch (key[i])
+        {
+        case '%':
+            os << "%25";
+            break;
+        case ';':
+            os << "%3B";
+            break;
+        case '\n':
+            os << "%0A";
+            break;
+        case '\r':
+            os << "%0D";
+            break;
+        default:
+            os << key[i];
+            break;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Hit counts of all values in @a pt, most accessed first.
+ *        Paths use the same notation as untouchedKeys().
+ */
+inline std::vector<AccessCount> accessProfile(const MyPTree& pt)
+{
+    std::vector<AccessCount> profile;
+    ptree_utils::detail::MyPTreePath path;
+    auto visit = [&profile](const ptree_utils::detail::MyPTreePath& p, std::size_t hits) {
+        const AccessCount count = { ptree_utils::detail::dumpPath(p), hits };
+        profile.push_back(count);
+    };
+    ptree_utils::detail::visitAccessCounts(pt, path, visit);
+
+    std::stable_sort(profile.begin(), profile.end(), ptree_utils::detail::moreAccessed);
+    return profile;
+}
+
+/**
+ * @brief The @a k most accessed values in @a pt, most accessed first.
+ *        Only the paths of the final @a k values are formatted.
+ */
+inline std::vector<AccessCount> topAccessedKeys(const MyPTree& pt,
+                                                const std::size_t k)
+{
+    struct Candidate
+    {
+        std::size_t hits;
+        std::size_t order;
+        ptree_utils::detail::MyPTreePath path;
+    };
+    // Heap with the least accessed candidate (and latest on ties) on top.
+    const auto better = [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.hits > rhs.hits ||
+               (lhs.hits == rhs.hits && lhs.order < rhs.order);
+    };
+
+    std::vector<Candidate> heap;
+    std::size_t order = 0;
+    ptree_utils::detail::MyPTreePath path;
+    auto visit = [&](const ptree_utils::detail::MyPTreePath& p, std::size_t hits) {
+        const std::size_t current = order++;
+        if (heap.size() < k)
+        {
+            const Candidate candidate = { hits, current, p };
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+        else if (k > 0 && hits > heap.front().hits)
+        {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back().hits = hits;
+            heap.back().order = current;
+            heap.back().path = p;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    };
+    ptree_utils::detail::visitAccessCounts(pt, path, visit);
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+
+    std::vector<AccessCount> top;
+    top.reserve(heap.size());
+    for (std::size_t i = 0; i < heap.size(); ++i)
+    {
+        const AccessCount count = { ptree_utils::detail::dumpPath(heap[i].path), heap[i].hits };
+        top.push_back(count);
+    }
+    return top;
+}
+
+/**
+ * @brief Write @a profile as a JSON array of {"path": ..., "hits": ...}.
+ */
+inline void writeAccessProfileJson(std::ostream& os,
+                                   const std::vector<AccessCount>& profile)
+{
+    os << "[";
+    for (std::size_t i = 0; i < profile.size(); ++i)
+    {
+        os << (i == 0 ? "\n" : ",\n") << "  {\"path\": ";
+        ptree_utils::detail::writeJsonString(os, profile[i].path);
+        os << ", \"hits\": " << profile[i].hits << "}";
+    }
+    os << "\n]\n";
+}
+
+/**
+ * @brief Write the hit counts of all values in @a pt in folded-stack
+ *        format, i.e. one "a;b;[0] hits" line per value, as consumed by
+ *        flame graph tools. Every key is one frame and array elements are
+ *        "[i]" frames. Folded stacks have no escaping, so '%', ';' and line
+ *        breaks within keys are percent-encoded.
+ */
+inline void writeAccessProfileFolded(std::ostream& os, const MyPTree& pt)
+{
+    ptree_utils::detail::MyPTreePath path;
+    auto visit = [&os](const ptree_utils::detail::MyPTreePath& p, std::size_t hits) {
+        for (std::size_t i = 0; i < p.size(); ++i)
+        {
+            if (i > 0)
+            {
+                os << ';';
+            }
+            if (p[i].key->empty())
+            {
+                os << "[" << p[i].index << "]";
+            }
+            else
+            {
+                ptree_utils::detail::writeFoldedFrame(os, *p[i].key);
+            }
+        }
+        os << " " << hits << "\n";
+    };
+    ptree_utils::detail::visitAccessCounts(pt, path, visit);
+}
+
 #endif // MY_PTREE_HPP_INCLUDED
@@ -0,0 +1,143 @@
+#ifndef PTREE_GENERATOR_HPP_INCLUDED
+#define PTREE_GENERATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <boost/property_tree/ptree.hpp>
+
+/**
+ * @brief Shape of a synthetic config tree.
+ */
+struct GeneratorOptions
+{
+    std::size_t depth = 4;          // Levels of objects below the root.
+    std::size_t fan_out = 8;        // Children per object.
+    std::size_t array_size = 4;     // Elements of the array in each object,
+                                    // zero for no arrays.
+    double duplicate_ratio = 0.0;   // Probability that a key repeats the
+                                    // previous sibling's key.
+    std::uint64_t seed = 42;
+};
+
+namespace ptree_utils {
+namespace detail {
+
+/**
+ * @brief SplitMix64, used instead of <random> distributions since those
+ *        are not guaranteed to produce the same sequence on every platform.
+ */
+class GeneratorRandom
+{
+public:
+    explicit GeneratorRandom(const std::uint64_t seed)
+            : state_(seed) {
+    }
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1).
+    double unit() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+inline std::string generateValue(GeneratorRandom& random)
+{
+    std::stringstream ss;
+    switch (random.next() % 4)
+    {
+    case 0:
+        ss << static_cast<std::int64_t>(random.next() % 2000000) - 1000000;
+        break;
+    case 1:
+        ss << random.unit() * 1000.0;
+        break;
+    case 2:
+        ss << ((random.next() % 2) == 0 ? "true" : "false");
+        break;
+    default:
+        ss << "value_" << random.next() % 1000;
+        break;
+    }
+    return ss.str();
+}
+
+template<class Tree>
+void generateTree(const GeneratorOptions& options, const std::size_t level,
+                  GeneratorRandom& random, Tree& tree)
+{
+    typedef typename Tree::key_type key_type;
+
+    key_type previous_key;
+    for (std::size_t i = 0; i < options.fan_out; ++i)
+    {
+        // Keys are a function of level and position only, so trees
+        // generated with different seeds overlap and can be merged.
+        std::stringstream ss;
+        ss << "key_" << level << "_" << i;
+        key_type key = ss.str();
+        if (i > 0 && random.unit() < options.duplicate_ratio)
+        {
+            key = previous_key;
+        }
+
+        Tree child;
+        if (level + 1 < options.depth)
+        {
+            generateTree(options, level + 1, random, child); // Recursive!
+        }
+        else
+        {
+            child.put_value(generateValue(random));
+        }
+        tree.push_back(std::make_pair(key, child));
+        previous_key = key;
+    }
+
+    if (options.array_size > 0)
+    {
+        Tree array;
+        for (std::size_t i = 0; i < options.array_size; ++i)
+        {
+            Tree element;
+            element.put_value(generateValue(random));
+            array.push_back(std::make_pair(key_type(), element));
+        }
+        std::stringstream ss;
+        ss << "array_" << level;
+        tree.push_back(std::make_pair(key_type(ss.str()), array));
+    }
+}
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Generate a synthetic config tree. The result depends only on
+ *        @a options, so the same options give the same tree on every run.
+ */
+template<class Tree = boost::property_tree::ptree>
+Tree generateTree(const GeneratorOptions& options)
+{
+    ptree_utils::detail::GeneratorRandom random(options.seed);
+    Tree tree;
+    if (options.depth > 0)
+    {
+        ptree_utils::detail::generateTree(options, 0, random, tree);
+    }
+    return tree;
+}
+
+#endif // PTREE_GENERATOR_HPP_INCLUDED
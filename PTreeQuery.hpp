@@ -0,0 +1,458 @@
+#ifndef PTREE_QUERY_HPP_INCLUDED
+#define PTREE_QUERY_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "PTreeUtils.hpp"
+
+/**
+ * @brief A compiled path query. Supported syntax, with segments separated
+ *        by '.':
+ *
+ *          name    child with key "name"
+ *          *       any child with a non-empty key
+ *          **      any number (including zero) of levels
+ *          [i]     array element i
+ *          [a:b]   array elements in [a, b), either bound may be omitted
+ *          [*]     any array element
+ *
+ *        Brackets may follow a name directly, as emitted by untouchedKeys(),
+ *        or form their own segment, as emitted by print(), i.e.
+ *        "stages[0]" and "stages.[0]" are the same query.
+ *        Keys containing '.', '[' or ']' cannot be expressed.
+ */
+class PTreeQuery
+{
+public:
+    enum StepType
+    {
+        KEY,       // Named child.
+        ANY_KEY,   // Any named child.
+        ANY_DEPTH, // Zero or more levels.
+        SLICE      // Array elements in [first, last).
+    };
+
+    struct Step
+    {
+        StepType type;
+        std::string key;
+        std::size_t first;
+        std::size_t last;
+    };
+
+    /**
+     * @throw std::invalid_argument if @a query is malformed.
+     */
+    explicit PTreeQuery(const std::string& query)
+            : query_(query) {
+        compile();
+    }
+
+    const std::string& str() const {
+        return query_;
+    }
+
+    const std::vector<Step>& steps() const {
+        return steps_;
+    }
+
+private:
+    void compile()
+    {
+        if (query_.empty())
+        {   // Matches the root.
+            return;
+        }
+
+        std::size_t begin = 0;
+        while (true)
+        {
+            const std::size_t dot = query_.find('.', begin);
+            const std::size_t end = dot == std::string::npos ? query_.size() : dot;
+            compileSegment(query_.substr(begin, end - begin));
+            if (dot == std::string::npos)
+            {
+                break;
+            }
+            begin = dot + 1;
+        }
+    }
+
+    void compileSegment(const std::string& segment)
+    {
+        const std::size_t bracket = std::min(segment.find('['), segment.size());
+        const std::string name = segment.substr(0, bracket);
+
+        if (name.empty() && bracket == segment.size())
+        {
+            fail("empty segment");
+        }
+        if (name.find(']') != std::string::npos)
+        {
+            fail("unexpected ']'");
+        }
+        if (name == "**")
+        {
+            if (bracket != segment.size())
+            {
+                fail("'**' cannot be indexed");
+            }
+            // Consecutive '**' are redundant.
+            if (steps_.empty() || steps_.back().type != ANY_DEPTH)
+            {
+                steps_.push_back(makeStep(ANY_DEPTH));
+            }
+            return;
+        }
+        if (name == "*")
+        {
+            steps_.push_back(makeStep(ANY_KEY));
+        }
+        else if (!name.empty())
+        {
+            if (name.find('*') != std::string::npos)
+            {
+                fail("'*' must be a whole segment");
+            }
+            Step step = makeStep(KEY);
+            step.key = name;
+            steps_.push_back(step);
+        }
+
+        std::size_t pos = bracket;
+        while (pos < segment.size())
+        {
+            if (segment[pos] != '[')
+            {
+                fail("expected '['");
+            }
+            const std::size_t close = segment.find(']', pos);
+            if (close == std::string::npos)
+            {
+                fail("missing ']'");
+            }
+            steps_.push_back(compileSlice(segment.substr(pos + 1, close - pos - 1)));
+            pos = close + 1;
+        }
+    }
+
+    Step compileSlice(const std::string& range) const
+    {
+        Step step = makeStep(SLICE);
+        if (range == "*")
+        {
+            return step;
+        }
+
+        const std::size_t colon = range.find(':');
+        if (colon == std::string::npos)
+        {
+            step.first = parseIndex(range);
+            step.last = step.first + 1;
+            return step;
+        }
+
+        const std::string first = range.substr(0, colon);
+        const std::string last = range.substr(colon + 1);
+        if (!first.empty())
+        {
+            step.first = parseIndex(first);
+        }
+        if (!last.empty())
+        {
+            step.last = parseIndex(last);
+        }
+        return step;
+    }
+
+    /**
+     * @brief Indices are bounded so that the end of a single-index slice,
+     *        index + 1, cannot overflow.
+     */
+    std::size_t parseIndex(const std::string& s) const
+    {
+        const std::size_t max_index = std::numeric_limits<std::size_t>::max() - 1;
+
+        if (s.empty())
+        {
+            fail("invalid index '" + s + "'");
+        }
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] < '0' || s[i] > '9')
+            {
+                fail("invalid index '" + s + "'");
+            }
+            const std::size_t digit = static_cast<std::size_t>(s[i] - '0');
+            if (index > (max_index - digit) / 10)
+            {
+                fail("invalid index '" + s + "'");
+            }
+            index = index * 10 + digit;
+        }
+        return index;
+    }
+
+    static Step makeStep(const StepType type)
+    {
+        Step step;
+        step.type = type;
+        step.first = 0;
+        step.last = std::numeric_limits<std::size_t>::max();
+        return step;
+    }
+
+    void fail(const std::string& what) const
+    {
+        throw std::invalid_argument(
+            "invalid query '" + query_ + "': " + what);
+    }
+
+    std::string query_;
+    std::vector<Step> steps_;
+};
+
+/**
+ * @brief A node matched by a query, with its path in "a.b[i]" notation.
+ *        The tree pointer is valid as long as the queried tree is unchanged.
+ */
+template<class K, class D, class C>
+struct QueryMatch
+{
+    std::string path;
+    const boost::property_tree::basic_ptree<K, D, C>* tree;
+};
+
+namespace ptree_utils {
+namespace detail {
+
+// Automaton state: a position within one of the queries.
+struct QueryState
+{
+    std::size_t query;
+    std::size_t step;
+
+    bool operator<(const QueryState& rhs) const {
+        return query < rhs.query || (query == rhs.query && step < rhs.step);
+    }
+
+    bool operator==(const QueryState& rhs) const {
+        return query == rhs.query && step == rhs.step;
+    }
+};
+
+/**
+ * @brief Add the states reachable from @a states without consuming a level,
+ *        i.e. skip over '**' steps. Also sorts and removes duplicates.
+ */
+inline void closeQueryStates(const std::vector<PTreeQuery>& queries,
+                             std::vector<QueryState>& states)
+{
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        const auto& steps = queries[states[i].query].steps();
+        if (states[i].step < steps.size() &&
+            steps[states[i].step].type == PTreeQuery::ANY_DEPTH)
+        {
+            const QueryState next = { states[i].query, states[i].step + 1 };
+            states.push_back(next);
+        }
+    }
+    std::sort(states.begin(), states.end());
+    states.erase(std::unique(states.begin(), states.end()), states.end());
+}
+
+/**
+ * @brief States after descending from a node in @a states to its child
+ *        with key @a key at position @a index.
+ */
+template<class K>
+void advanceQueryStates(const std::vector<PTreeQuery>& queries,
+                        const std::vector<QueryState>& states,
+                        const K& key, const std::size_t index,
+                        std::vector<QueryState>& next)
+{
+    next.clear();
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        const auto& steps = queries[states[i].query].steps();
+        if (states[i].step == steps.size())
+        {   // Already matched, nothing more to consume.
+            continue;
+        }
+
+        const PTreeQuery::Step& step = steps[states[i].step];
+        bool advance = false;
+        switch (step.type)
+        {
+        case PTreeQuery::KEY:
+            advance = !key.empty() && key == step.key;
+            break;
+        case PTreeQuery::ANY_KEY:
+            advance = !key.empty();
+            break;
+        case PTreeQuery::SLICE:
+            advance = key.empty() && step.first <= index && index < step.last;
+            break;
+        case PTreeQuery::ANY_DEPTH:
+            // Stay on '**' to consume further levels.
+            next.push_back(states[i]);
+            break;
+        }
+        if (advance)
+        {
+            const QueryState state = { states[i].query, states[i].step + 1 };
+            next.push_back(state);
+        }
+    }
+    closeQueryStates(queries, next);
+}
+
+/**
+ * @brief If every state in @a states waits for the same named child,
+ *        return that key so the children can be looked up instead of
+ *        scanned. Otherwise return null.
+ */
+inline const std::string* singleQueryKey(const std::vector<PTreeQuery>& queries,
+                                         const std::vector<QueryState>& states)
+{
+    const std::string* key = nullptr;
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        const auto& steps = queries[states[i].query].steps();
+        if (states[i].step == steps.size())
+        {
+            continue;
+        }
+        const PTreeQuery::Step& step = steps[states[i].step];
+        if (step.type != PTreeQuery::KEY || (key != nullptr && *key != step.key))
+        {
+            return nullptr;
+        }
+        key = &step.key;
+    }
+    return key;
+}
+
+template<class K, class D, class C>
+void recordQueryMatches(
+        const std::vector<PTreeQuery>& queries,
+        const std::vector<QueryState>& states,
+        const boost::property_tree::basic_ptree<K, D, C>& tree,
+        const std::vector<PathElement<K>>& path,
+        std::vector<std::vector<QueryMatch<K, D, C>>>& matches)
+{
+    std::string dumped;
+    bool is_dumped = false;
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+        if (states[i].step == queries[states[i].query].steps().size())
+        {
+            if (!is_dumped)
+            {
+                dumped = dumpPath(path);
+                is_dumped = true;
+            }
+            const QueryMatch<K, D, C> match = { dumped, &tree };
+            matches[states[i].query].push_back(match);
+        }
+    }
+}
+
+template<class K, class D, class C>
+void queryTree(
+        const std::vector<PTreeQuery>& queries,
+        const boost::property_tree::basic_ptree<K, D, C>& tree,
+        const std::vector<QueryState>& states,
+        std::vector<PathElement<K>>& path,
+        std::vector<std::vector<QueryMatch<K, D, C>>>& matches)
+{
+    std::vector<QueryState> next;
+
+    const std::string* key = singleQueryKey(queries, states);
+    if (key != nullptr)
+    {
+        // Only one named child can match, use the key index.
+        const auto range = tree.equal_range(*key);
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            advanceQueryStates(queries, states, iter->first, 0, next);
+            const PathElement<K> element = { &iter->first, 0 };
+            path.push_back(element);
+            recordQueryMatches(queries, next, iter->second, path, matches);
+            queryTree(queries, iter->second, next, path, matches); // Recursive!
+            path.pop_back();
+        }
+        return;
+    }
+
+    std::size_t index = 0;
+    const auto iend = tree.end();
+    for (auto iter = tree.begin(); iter != iend; ++iter, ++index)
+    {
+        advanceQueryStates(queries, states, iter->first, index, next);
+        if (next.empty())
+        {   // Prune, no query can match below this child.
+            continue;
+        }
+        const PathElement<K> element = { &iter->first, index };
+        path.push_back(element);
+        recordQueryMatches(queries, next, iter->second, path, matches);
+        queryTree(queries, iter->second, next, path, matches); // Recursive!
+        path.pop_back();
+    }
+}
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Evaluate several queries in a single traversal of @a pt.
+ *        The queries run as one automaton, and subtrees where no query
+ *        can match are skipped.
+ * @return For each query, its matches in traversal order.
+ */
+template<class K, class D, class C>
+std::vector<std::vector<QueryMatch<K, D, C>>> queryTree(
+        const boost::property_tree::basic_ptree<K, D, C>& pt,
+        const std::vector<PTreeQuery>& queries)
+{
+    std::vector<std::vector<QueryMatch<K, D, C>>> matches(queries.size());
+
+    std::vector<ptree_utils::detail::QueryState> states;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        const ptree_utils::detail::QueryState state = { i, 0 };
+        states.push_back(state);
+    }
+    ptree_utils::detail::closeQueryStates(queries, states);
+
+    std::vector<ptree_utils::detail::PathElement<K>> path;
+    ptree_utils::detail::recordQueryMatches(queries, states, pt, path, matches);
+    ptree_utils::detail::queryTree(queries, pt, states, path, matches);
+
+    return matches;
+}
+
+/**
+ * @brief Evaluate a single query on @a pt.
+ * @return Matches in traversal order.
+ */
+template<class K, class D, class C>
+std::vector<QueryMatch<K, D, C>> queryTree(
+        const boost::property_tree::basic_ptree<K, D, C>& pt,
+        const PTreeQuery& query)
+{
+    return queryTree(pt, std::vector<PTreeQuery>(1, query)).front();
+}
+
+#endif // PTREE_QUERY_HPP_INCLUDED
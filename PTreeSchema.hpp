@@ -0,0 +1,315 @@
+#ifndef PTREE_SCHEMA_HPP_INCLUDED
+#define PTREE_SCHEMA_HPP_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "PTreeTranslators.hpp"
+#include "PTreeUtils.hpp"
+
+/**
+ * @brief Outcome of binding a tree against a PTreeSchema. All paths use
+ *        the same "a.b[i]" notation as untouchedKeys().
+ */
+struct SchemaReport
+{
+    std::vector<std::string> missing;   // Required fields not in the tree.
+    std::vector<std::string> invalid;   // Fields whose value did not parse.
+    std::vector<std::string> unknown;   // Keys not described by the schema.
+    std::vector<std::string> duplicate; // Keys that appear more than once.
+
+    /**
+     * @brief Unknown keys are reported but do not make a binding fail.
+     * @return True if every field was bound, otherwise false.
+     */
+    bool ok() const {
+        return missing.empty() && invalid.empty() && duplicate.empty();
+    }
+};
+
+namespace ptree_utils {
+namespace detail {
+
+/**
+ * @brief Reads a single field value from a tree node. Scalars must be
+ *        leaves and go through ValueTranslator, so arithmetic fields bind
+ *        from ptree and MyPTree whether or not the fast translators are
+ *        registered as default.
+ */
+template<typename V>
+struct FieldBinder
+{
+    template<class Tree>
+    static bool bind(const Tree& node, V& out)
+    {
+        if (!isLeafTree(node))
+        {
+            return false;
+        }
+        typedef typename ValueTranslator<typename Tree::data_type, V>::type
+            translator_type;
+        const auto value = node.template get_value_optional<V>(translator_type());
+        if (!value)
+        {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+};
+
+/**
+ * @brief Arrays of scalars bind to std::vector. Note that the JSON parser
+ *        stores an empty array as an empty leaf.
+ */
+template<typename V, typename A>
+struct FieldBinder<std::vector<V, A>>
+{
+    template<class Tree>
+    static bool bind(const Tree& node, std::vector<V, A>& out)
+    {
+        if (isLeafTree(node))
+        {
+            if (!node.template get_value<std::string>().empty())
+            {
+                return false;
+            }
+            out.clear();
+            return true;
+        }
+        if (!isArrayTree(node))
+        {
+            return false;
+        }
+
+        std::vector<V, A> values;
+        values.reserve(node.size());
+        const auto iend = node.end();
+        for (auto iter = node.begin(); iter != iend; ++iter)
+        {
+            V value;
+            if (!FieldBinder<V>::bind(iter->second, value))
+            {
+                return false;
+            }
+            values.push_back(value);
+        }
+        out.swap(values);
+        return true;
+    }
+};
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Declarative description of a config layout that binds a tree into
+ *        a plain struct @a T in a single traversal.
+ *
+ *        Field paths are compiled into a trie of keys when they are added,
+ *        so binding visits every tree node once and never performs string
+ *        path lookups. Keys that are not part of the schema are reported
+ *        as unknown rather than silently ignored.
+ *
+ * @code
+ *   PTreeSchema<Config> schema;
+ *   schema.required("frame.index", &Config::index)
+ *         .optional("frame.dt", &Config::dt, 0.16);
+ *   const SchemaReport report = schema.bind(pt, config);
+ * @endcode
+ */
+template<class T, class Tree = boost::property_tree::ptree>
+class PTreeSchema
+{
+public:
+    typedef typename Tree::key_type key_type;
+
+    PTreeSchema()
+            : nodes_(1) {
+    }
+
+    /**
+     * @brief Add a field that must be present in the tree.
+     * @throw std::invalid_argument if @a path clashes with another field.
+     */
+    template<typename V>
+    PTreeSchema& required(const key_type& path, V T::* member)
+    {
+        addField(path, member, true, std::function<void(T&)>());
+        return *this;
+    }
+
+    /**
+     * @brief Add a field that is set to @a default_value if not present.
+     * @throw std::invalid_argument if @a path clashes with another field.
+     */
+    template<typename V>
+    PTreeSchema& optional(const key_type& path, V T::* member,
+                          const V& default_value)
+    {
+        addField(path, member, false, [member, default_value](T& out) {
+            out.*member = default_value;
+        });
+        return *this;
+    }
+
+    /**
+     * @brief Validate @a pt and bind its values into @a out.
+     *        Fields that fail to parse keep their previous value.
+     * @return Report of missing, invalid, unknown and duplicate keys.
+     */
+    SchemaReport bind(const Tree& pt, T& out) const
+    {
+        SchemaReport report;
+        std::vector<bool> visited(nodes_.size(), false);
+        std::vector<PathElement> path;
+
+        bindTree(pt, 0, out, path, visited, report);
+
+        for (std::size_t i = 0; i < fields_.size(); ++i)
+        {
+            const Field& field = fields_[i];
+            if (!visited[field.node])
+            {
+                if (field.required)
+                {
+                    report.missing.push_back(field.path);
+                }
+                else
+                {
+                    field.set_default(out);
+                }
+            }
+        }
+
+        return report;
+    }
+
+private:
+    struct Node
+    {
+        std::map<key_type, std::size_t> children;
+        std::ptrdiff_t field = -1;
+    };
+
+    struct Field
+    {
+        key_type path;
+        std::size_t node;
+        bool required;
+        std::function<bool(const Tree&, T&)> bind;
+        std::function<void(T&)> set_default;
+    };
+
+    typedef ptree_utils::detail::PathElement<key_type> PathElement;
+
+    template<typename V>
+    void addField(const key_type& path, V T::* member, const bool required,
+                  const std::function<void(T&)>& set_default)
+    {
+        typedef typename Tree::path_type path_type;
+
+        std::size_t node = 0;
+        path_type p(path);
+        while (!p.empty())
+        {
+            if (nodes_[node].field >= 0)
+            {
+                throw std::invalid_argument(
+                    "schema field '" + path + "' is nested in another field");
+            }
+            const key_type key = p.reduce();
+            const auto iter = nodes_[node].children.find(key);
+            if (iter != nodes_[node].children.end())
+            {
+                node = iter->second;
+            }
+            else
+            {
+                nodes_.push_back(Node());
+                nodes_[node].children.insert(std::make_pair(key, nodes_.size() - 1));
+                node = nodes_.size() - 1;
+            }
+        }
+        if (node == 0 || nodes_[node].field >= 0 ||
+            !nodes_[node].children.empty())
+        {
+            throw std::invalid_argument(
+                "schema field '" + path + "' clashes with another field");
+        }
+
+        Field field;
+        field.path = path;
+        field.node = node;
+        field.required = required;
+        field.bind = [member](const Tree& tree, T& out) {
+            return ptree_utils::detail::FieldBinder<V>::bind(tree, out.*member);
+        };
+        field.set_default = set_default;
+
+        nodes_[node].field = static_cast<std::ptrdiff_t>(fields_.size());
+        fields_.push_back(field);
+    }
+
+    void bindTree(const Tree& tree, const std::size_t node, T& out,
+                  std::vector<PathElement>& path, std::vector<bool>& visited,
+                  SchemaReport& report) const
+    {
+        const auto& children = nodes_[node].children;
+
+        std::size_t index = 0;
+        const auto iend = tree.end();
+        for (auto iter = tree.begin(); iter != iend; ++iter, ++index)
+        {
+            const key_type& sub_key = iter->first;
+            const Tree& sub_tree = iter->second;
+
+            const PathElement element = { &sub_key, index };
+            path.push_back(element);
+
+            const auto match = sub_key.empty() ? children.end()
+                                               : children.find(sub_key);
+            if (match == children.end())
+            {
+                report.unknown.push_back(ptree_utils::detail::dumpPath(path));
+            }
+            else if (visited[match->second] && nodes_[match->second].field >= 0)
+            {
+                report.duplicate.push_back(ptree_utils::detail::dumpPath(path));
+            }
+            else
+            {
+                // Objects may be repeated as long as the fields they contain
+                // are not, which is caught when recursing.
+                visited[match->second] = true;
+                const std::ptrdiff_t field = nodes_[match->second].field;
+                if (field >= 0)
+                {
+                    if (!fields_[field].bind(sub_tree, out))
+                    {
+                        report.invalid.push_back(ptree_utils::detail::dumpPath(path));
+                    }
+                }
+                else
+                {
+                    // Recursive!
+                    bindTree(sub_tree, match->second, out, path, visited, report);
+                }
+            }
+
+            path.pop_back();
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<Field> fields_;
+};
+
+#endif // PTREE_SCHEMA_HPP_INCLUDED
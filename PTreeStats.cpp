@@ -0,0 +1,41 @@
+#include "PTreeStats.hpp"
+
+#ifdef PTREE_UTILS_ENABLE_STATS
+
+#include <cstdlib>
+#include <new>
+
+// Replacements of the global operator new/delete that count the bytes
+// allocated by instrumented operations. They are defined out of line, in
+// their own translation unit, so the compiler does not see operator new
+// paired with std::free.
+
+void* operator new(std::size_t size)
+{
+    ::ptree_utils::detail::threadAllocatedBytes() += size;
+    while (true)
+    {
+        if (void* p = std::malloc(size == 0 ? 1 : size))
+        {
+            return p;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif // PTREE_UTILS_ENABLE_STATS
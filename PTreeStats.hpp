@@ -0,0 +1,255 @@
+#ifndef PTREE_STATS_HPP_INCLUDED
+#define PTREE_STATS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef PTREE_UTILS_ENABLE_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+/**
+ * @brief Counters for a single instrumented operation.
+ */
+struct OperationStats
+{
+    std::uint64_t calls = 0;           // Top-level calls, recursion excluded.
+    std::uint64_t nodes_visited = 0;   // Tree nodes inspected.
+    std::uint64_t bytes_allocated = 0; // Needs PTreeStats.cpp, see below.
+    std::uint64_t nanoseconds = 0;     // Wall time of top-level calls.
+    std::uint64_t lookups = 0;         // Path or value lookups.
+    std::uint64_t lookup_hits = 0;     // Lookups that found an existing
+                                       // path or a touched value.
+};
+
+/**
+ * @brief Snapshot of the counters of all instrumented operations.
+ */
+struct PTreeStats
+{
+    OperationStats read_json;        // readJsonString
+    OperationStats merge;            // merge
+    OperationStats has_unique_paths; // hasUniquePaths
+    OperationStats untouched_keys;   // untouchedKeys
+};
+
+enum PTreeOperation
+{
+    PTREE_OP_READ_JSON,
+    PTREE_OP_MERGE,
+    PTREE_OP_HAS_UNIQUE_PATHS,
+    PTREE_OP_UNTOUCHED_KEYS,
+    PTREE_OP_COUNT
+};
+
+#ifdef PTREE_UTILS_ENABLE_STATS
+
+namespace ptree_utils {
+namespace detail {
+
+struct AtomicOperationStats
+{
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> nodes_visited{0};
+    std::atomic<std::uint64_t> bytes_allocated{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+    std::atomic<std::uint64_t> lookups{0};
+    std::atomic<std::uint64_t> lookup_hits{0};
+
+    OperationStats load() const {
+        OperationStats s;
+        s.calls = calls.load(std::memory_order_relaxed);
+        s.nodes_visited = nodes_visited.load(std::memory_order_relaxed);
+        s.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        s.nanoseconds = nanoseconds.load(std::memory_order_relaxed);
+        s.lookups = lookups.load(std::memory_order_relaxed);
+        s.lookup_hits = lookup_hits.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() {
+        calls = 0;
+        nodes_visited = 0;
+        bytes_allocated = 0;
+        nanoseconds = 0;
+        lookups = 0;
+        lookup_hits = 0;
+    }
+};
+
+inline AtomicOperationStats* operationStats()
+{
+    static AtomicOperationStats stats[PTREE_OP_COUNT];
+    return stats;
+}
+
+// Bytes allocated by this thread, advanced by the operator new in
+// PTreeStats.cpp.
+inline std::uint64_t& threadAllocatedBytes()
+{
+    thread_local std::uint64_t bytes = 0;
+    return bytes;
+}
+
+// Nesting depth per operation, so that recursive calls are timed once.
+inline int& threadOperationDepth(const PTreeOperation op)
+{
+    thread_local int depth[PTREE_OP_COUNT] = {};
+    return depth[op];
+}
+
+// Counts of the outermost call in progress, added to the shared counters
+// once when it returns.
+struct PendingCounts
+{
+    std::uint64_t nodes_visited = 0;
+    std::uint64_t lookups = 0;
+    std::uint64_t lookup_hits = 0;
+};
+
+inline PendingCounts& threadPendingCounts(const PTreeOperation op)
+{
+    thread_local PendingCounts pending[PTREE_OP_COUNT];
+    return pending[op];
+}
+
+inline void recordNodes(const PTreeOperation op, const std::uint64_t n)
+{
+    if (threadOperationDepth(op) > 0)
+    {
+        threadPendingCounts(op).nodes_visited += n;
+    }
+    else
+    {
+        operationStats()[op].nodes_visited.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+inline void recordLookup(const PTreeOperation op, const bool hit)
+{
+    if (threadOperationDepth(op) > 0)
+    {
+        PendingCounts& pending = threadPendingCounts(op);
+        ++pending.lookups;
+        pending.lookup_hits += hit ? 1 : 0;
+    }
+    else
+    {
+        AtomicOperationStats& stats = operationStats()[op];
+        stats.lookups.fetch_add(1, std::memory_order_relaxed);
+        stats.lookup_hits.fetch_add(hit ? 1 : 0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Records calls, wall time, allocated bytes and the pending counts
+ *        of the outermost call of an operation on the current thread.
+ *        Nested calls only track the depth.
+ */
+class OperationScope
+{
+public:
+    explicit OperationScope(const PTreeOperation op)
+            : op_(op)
+            , outermost_(threadOperationDepth(op)++ == 0)
+            , bytes_(0) {
+        if (outermost_)
+        {
+            bytes_ = threadAllocatedBytes();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~OperationScope() {
+        --threadOperationDepth(op_);
+        if (!outermost_)
+        {
+            return;
+        }
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        const std::uint64_t bytes = threadAllocatedBytes() - bytes_;
+
+        PendingCounts& pending = threadPendingCounts(op_);
+        AtomicOperationStats& stats = operationStats()[op_];
+        stats.calls.fetch_add(1, std::memory_order_relaxed);
+        stats.nanoseconds.fetch_add(static_cast<std::uint64_t>(ns),
+                                    std::memory_order_relaxed);
+        stats.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        stats.nodes_visited.fetch_add(pending.nodes_visited,
+                                      std::memory_order_relaxed);
+        stats.lookups.fetch_add(pending.lookups, std::memory_order_relaxed);
+        stats.lookup_hits.fetch_add(pending.lookup_hits,
+                                    std::memory_order_relaxed);
+        pending = PendingCounts();
+    }
+
+    OperationScope(const OperationScope&) = delete;
+    OperationScope& operator=(const OperationScope&) = delete;
+
+private:
+    PTreeOperation op_;
+    bool outermost_;
+    std::uint64_t bytes_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace detail
+} // namespace ptree_utils
+
+inline PTreeStats ptreeStats()
+{
+    const ptree_utils::detail::AtomicOperationStats* stats =
+        ptree_utils::detail::operationStats();
+    PTreeStats snapshot;
+    snapshot.read_json = stats[PTREE_OP_READ_JSON].load();
+    snapshot.merge = stats[PTREE_OP_MERGE].load();
+    snapshot.has_unique_paths = stats[PTREE_OP_HAS_UNIQUE_PATHS].load();
+    snapshot.untouched_keys = stats[PTREE_OP_UNTOUCHED_KEYS].load();
+    return snapshot;
+}
+
+inline void resetPTreeStats()
+{
+    for (int op = 0; op < PTREE_OP_COUNT; ++op)
+    {
+        ptree_utils::detail::operationStats()[op].reset();
+    }
+}
+
+// Node counts and lookups inside an operation scope are only added to the
+// shared counters when the scope ends, so they add no atomic operations to
+// the timed code.
+#define PTREE_STATS_SCOPE(op) \
+    const ::ptree_utils::detail::OperationScope ptree_stats_scope_(op)
+#define PTREE_STATS_NODES(op, n) \
+    ::ptree_utils::detail::recordNodes((op), (n))
+#define PTREE_STATS_LOOKUP(op, hit) \
+    ::ptree_utils::detail::recordLookup((op), (hit))
+
+// Allocated bytes are counted by replacements of the global operator
+// new/delete in PTreeStats.cpp, which must be linked into the program.
+// Without it bytes_allocated stays zero.
+
+#else // PTREE_UTILS_ENABLE_STATS
+
+// Instrumentation is compiled out, the snapshot is always zero.
+inline PTreeStats ptreeStats()
+{
+    return PTreeStats();
+}
+
+inline void resetPTreeStats()
+{
+}
+
+// Arguments are not evaluated, sizeof only marks them as used.
+#define PTREE_STATS_SCOPE(op) ((void)0)
+#define PTREE_STATS_NODES(op, n) ((void)0)
+#define PTREE_STATS_LOOKUP(op, hit) ((void)sizeof(hit))
+
+#endif // PTREE_UTILS_ENABLE_STATS
+
+#endif // PTREE_STATS_HPP_INCLUDED
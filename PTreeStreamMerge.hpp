@@ -0,0 +1,469 @@
+#ifndef PTREE_STREAM_MERGE_HPP_INCLUDED
+#define PTREE_STREAM_MERGE_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "PTreeUtils.hpp"
+
+namespace ptree_utils {
+namespace detail {
+
+/**
+ * @brief JSON parser callbacks that merge the parsed document into a base
+ *        tree as it is read, see mergeJson().
+ *
+ *        Objects are only tracked as a stack of frames. Leaves and arrays,
+ *        which merge() puts as a whole, are built with the standard
+ *        callbacks and put into the base tree as soon as they complete.
+ *
+ *        merge() puts values breadth-first, which decides where new keys
+ *        end up among their siblings. Values whose parent already exists
+ *        in the base tree are put immediately, which gives the same order.
+ *        Values below a new object are held back until the nearest existing
+ *        ancestor object closes, and are then put in breadth-first order.
+ *
+ *        merge() also puts objects whose keys are all empty as a whole,
+ *        like arrays. The members of an object are therefore buffered
+ *        until its first non-empty key, and then streamed as usual.
+ *
+ *        NOTE: Relies on the callback interface of Boost's JSON parser
+ *        (json_parser::detail, Boost 1.59 and later), which is not part of
+ *        its documented API.
+ */
+class StreamingMergeCallbacks
+{
+public:
+    typedef boost::property_tree::ptree ptree;
+    typedef boost::property_tree::json_parser::detail::standard_callbacks<ptree>
+        value_callbacks;
+    typedef char char_type;
+
+    explicit StreamingMergeCallbacks(ptree& base)
+            : base_(base)
+            , capture_depth_(0)
+            , capturing_(false)
+            , in_key_(false)
+            , root_is_object_(false) {
+    }
+
+    void on_null() {
+        beginValue();
+        value_.on_null();
+        endValue();
+    }
+
+    void on_boolean(bool b) {
+        beginValue();
+        value_.on_boolean(b);
+        endValue();
+    }
+
+    template <typename Range>
+    void on_number(Range code_units) {
+        beginValue();
+        value_.on_number(code_units);
+        endValue();
+    }
+
+    void on_begin_number() {
+        beginValue();
+        value_.on_begin_number();
+    }
+
+    void on_digit(char_type d) {
+        value_.on_digit(d);
+    }
+
+    void on_end_number() {
+        value_.on_end_number();
+        endValue();
+    }
+
+    void on_begin_string() {
+        if (!capturing_ && !frames_.empty() && frames_.back().expect_key)
+        {
+            in_key_ = true;
+            key_.clear();
+            return;
+        }
+        beginValue();
+        value_.on_begin_string();
+    }
+
+    template <typename Range>
+    void on_code_units(Range code_units) {
+        if (in_key_)
+        {
+            key_.append(code_units.begin(), code_units.end());
+            return;
+        }
+        value_.on_code_units(code_units);
+    }
+
+    void on_code_unit(char_type c) {
+        if (in_key_)
+        {
+            key_ += c;
+            return;
+        }
+        value_.on_code_unit(c);
+    }
+
+    void on_end_string() {
+        if (in_key_)
+        {
+            in_key_ = false;
+            if (frames_.back().pending && !key_.empty())
+            {
+                resolvePending();
+            }
+            frames_.back().key = key_;
+            frames_.back().expect_key = false;
+            return;
+        }
+        value_.on_end_string();
+        endValue();
+    }
+
+    void on_begin_array() {
+        beginValue();
+        ++capture_depth_;
+        value_.on_begin_array();
+    }
+
+    void on_end_array() {
+        value_.on_end_array();
+        --capture_depth_;
+        endValue();
+    }
+
+    void on_begin_object() {
+        if (capturing_ || (!frames_.empty() && frames_.back().pending))
+        {   // Object within an array, or member of a possible array.
+            beginValue();
+            ++capture_depth_;
+            value_.on_begin_object();
+            return;
+        }
+
+        if (frames_.empty())
+        {
+            root_is_object_ = true;
+        }
+        pushFrame(true);
+    }
+
+    void on_end_object() {
+        if (capturing_)
+        {
+            value_.on_end_object();
+            --capture_depth_;
+            endValue();
+            return;
+        }
+
+        if (!frames_.back().pending)
+        {
+            popFrame();
+            return;
+        }
+
+        // No member with a non-empty key, which merge() treats as an array,
+        // or as a leaf if there are no members at all.
+        ptree value;
+        value.swap(frames_.back().buffer);
+        frames_.pop_back();
+        if (frames_.empty())
+        {   // Like a top-level array, nothing to stream.
+            if (!value.empty())
+            {
+                base_ = merge(base_, value);
+            }
+        }
+        else
+        {
+            put(value);
+            memberDone();
+        }
+    }
+
+    /**
+     * @brief Handle a document that is not an object, which merge() is
+     *        applied to as a whole.
+     */
+    void finish() {
+        if (!root_is_object_)
+        {   // Top-level array or value, nothing to stream.
+            base_ = merge(base_, value_.output());
+        }
+    }
+
+private:
+    /**
+     * @brief An object of the override document. The path of an object
+     *        that exists in the base tree is absolute and its order empty.
+     *        Both are relative to the nearest existing ancestor for a new
+     *        object.
+     *
+     *        Until a member with a non-empty key is seen, the object may be
+     *        an array to merge(), so its members are kept in buffer.
+     */
+    struct Frame
+    {
+        ptree::path_type path;
+        std::vector<std::size_t> order; // Member indices.
+        ptree::key_type key;            // Key of the member being parsed.
+        ptree buffer;                   // Members while pending.
+        std::size_t members;            // Members completed so far.
+        std::size_t deferred_begin;     // First value held back below it.
+        bool expect_key;
+        bool exists;                    // Does path exist in the base tree?
+        bool pending;                   // Have all keys been empty so far?
+    };
+
+    // A value below a new object, relative to its nearest existing ancestor.
+    struct Deferred
+    {
+        ptree::path_type path;
+        std::vector<std::size_t> order;
+        ptree value;
+    };
+
+    // Breadth-first order, i.e. by depth and then by member indices.
+    static bool bfsOrder(const Deferred& lhs, const Deferred& rhs) {
+        if (lhs.order.size() != rhs.order.size())
+        {
+            return lhs.order.size() < rhs.order.size();
+        }
+        return lhs.order < rhs.order;
+    }
+
+    void pushFrame(const bool pending) {
+        Frame frame;
+        frame.expect_key = true;
+        frame.members = 0;
+        frame.deferred_begin = deferred_.size();
+        frame.pending = pending;
+        if (frames_.empty())
+        {
+            frame.exists = true;
+        }
+        else
+        {
+            const Frame& parent = frames_.back();
+            if (parent.exists)
+            {
+                frame.path = parent.path / ptree::path_type(parent.key);
+                // An empty key refers to the parent itself. merge() puts
+                // its members a level later, so they are held back like
+                // those of a new object.
+                frame.exists = !parent.key.empty() &&
+                    base_.get_child_optional(frame.path).is_initialized();
+                if (!frame.exists)
+                {   // First new object, relative to its existing parent.
+                    frame.path = ptree::path_type(parent.key);
+                    frame.order.push_back(parent.members);
+                }
+            }
+            else
+            {
+                frame.path = parent.path / ptree::path_type(parent.key);
+                frame.order = parent.order;
+                frame.order.push_back(parent.members);
+                frame.exists = false;
+            }
+        }
+        frames_.push_back(frame);
+    }
+
+    void popFrame() {
+        if (frames_.back().exists)
+        {
+            flush(frames_.back());
+        }
+        frames_.pop_back();
+        if (!frames_.empty())
+        {
+            memberDone();
+        }
+    }
+
+    /**
+     * @brief The current object has a non-empty key, so it is not an
+     *        array. Stream its buffered members, which all have empty keys.
+     */
+    void resolvePending() {
+        frames_.back().pending = false;
+        ptree buffered;
+        buffered.swap(frames_.back().buffer);
+        const auto iend = buffered.end();
+        for (auto iter = buffered.begin(); iter != iend; ++iter)
+        {
+            frames_.back().key = iter->first;
+            replayMember(iter->second);
+        }
+    }
+
+    // Stream @a value, a complete member of the current object.
+    void replayMember(ptree& value) {
+        if (isLeafTree(value) || isArrayTree(value))
+        {
+            put(value);
+            memberDone();
+            return;
+        }
+
+        pushFrame(false);
+        const auto iend = value.end();
+        for (auto iter = value.begin(); iter != iend; ++iter)
+        {
+            frames_.back().key = iter->first;
+            replayMember(iter->second); // Recursive!
+        }
+        popFrame();
+    }
+
+    void beginValue() {
+        if (!capturing_)
+        {
+            capturing_ = true;
+            value_ = value_callbacks();
+        }
+    }
+
+    void endValue() {
+        if (capture_depth_ > 0)
+        {
+            return;
+        }
+        capturing_ = false;
+        if (!frames_.empty())
+        {
+            put(value_.output());
+            memberDone();
+        }
+    }
+
+    void put(ptree& value) {
+        Frame& frame = frames_.back();
+        if (frame.pending)
+        {
+            frame.buffer.push_back(std::make_pair(frame.key, ptree()));
+            frame.buffer.back().second.swap(value);
+            return;
+        }
+
+        const ptree::path_type path = frame.path / ptree::path_type(frame.key);
+        if (frame.exists)
+        {
+            base_.put_child(path, value);
+        }
+        else
+        {
+            deferred_.push_back(Deferred());
+            Deferred& deferred = deferred_.back();
+            deferred.path = path;
+            deferred.order = frame.order;
+            deferred.order.push_back(frame.members);
+            deferred.value.swap(value);
+        }
+    }
+
+    /**
+     * @brief Put the values held back below the existing object @a frame,
+     *        which is complete. merge() has put all its direct leaves and
+     *        arrays at this point, so only their mutual order matters.
+     */
+    void flush(const Frame& frame) {
+        if (frame.deferred_begin == deferred_.size())
+        {
+            return;
+        }
+
+        ptree& node = base_.get_child(frame.path);
+        const auto first = deferred_.begin() +
+            static_cast<std::ptrdiff_t>(frame.deferred_begin);
+        std::stable_sort(first, deferred_.end(), bfsOrder);
+        for (auto iter = first; iter != deferred_.end(); ++iter)
+        {
+            ptree_utils::detail::putChild(node, iter->path, iter->value);
+        }
+        deferred_.erase(first, deferred_.end());
+    }
+
+    void memberDone() {
+        ++frames_.back().members;
+        frames_.back().expect_key = true;
+    }
+
+    ptree& base_;
+    std::vector<Frame> frames_;
+    std::vector<Deferred> deferred_;
+    value_callbacks value_;
+    int capture_depth_;
+    bool capturing_;
+    bool in_key_;
+    bool root_is_object_;
+    std::string key_;
+};
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Merge the JSON document read from @a is into @a base, with the
+ *        same result as merge(base, override) but without parsing the
+ *        override document into a tree first.
+ *
+ *        Each leaf or array is put into @a base as soon as it has been
+ *        parsed, so besides @a base only the current path and the current
+ *        leaf or array are kept in memory. The exception is values below
+ *        objects that do not exist in @a base: to keep the key order of
+ *        merge(), these are held back until the enclosing object that does
+ *        exist in @a base is complete. Peak memory is therefore bounded by
+ *        the largest new sub-tree rather than all new data. Objects whose
+ *        keys are all empty are arrays to merge(), and are kept whole too.
+ *
+ *        The key order matches merge() when the override document has
+ *        unique paths, see hasUniquePaths(). An empty key does not extend
+ *        the path, so a member with an empty key must not repeat the paths
+ *        of its siblings either.
+ *
+ * @throw boost::property_tree::json_parser_error on malformed input, in
+ *        which case @a base may be partially merged.
+ */
+inline void mergeJson(boost::property_tree::ptree& base, std::istream& is,
+                      const std::string& filename = std::string())
+{
+    namespace jp = boost::property_tree::json_parser;
+    typedef std::istreambuf_iterator<char> iterator;
+
+    ptree_utils::detail::StreamingMergeCallbacks callbacks(base);
+    jp::detail::encoding<char> encoding;
+    jp::detail::read_json_internal(iterator(is), iterator(), encoding,
+                                   callbacks, filename);
+    callbacks.finish();
+}
+
+/**
+ * @brief Merge @a json_data into @a base, see mergeJson().
+ */
+inline void mergeJsonString(boost::property_tree::ptree& base,
+                            const char* json_data)
+{
+    std::stringstream ss;
+    ss << json_data;
+    mergeJson(base, ss);
+}
+
+#endif // PTREE_STREAM_MERGE_HPP_INCLUDED
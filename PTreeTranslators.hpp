@@ -0,0 +1,225 @@
+#ifndef PTREE_TRANSLATORS_HPP_INCLUDED
+#define PTREE_TRANSLATORS_HPP_INCLUDED
+
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <boost/optional/optional.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+namespace ptree_utils {
+namespace detail {
+
+// The whitespace of std::isspace in the "C" locale.
+inline bool isWhitespace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+           c == '\r';
+}
+
+/**
+ * @brief Strip leading and trailing whitespace from [@a first, @a last).
+ *        The default stream translator skips surrounding whitespace, so we
+ *        do the same to stay compatible with existing config files.
+ */
+inline void trimWhitespace(const char*& first, const char*& last)
+{
+    while (first != last && isWhitespace(*first))
+    {
+        ++first;
+    }
+    while (last != first && isWhitespace(last[-1]))
+    {
+        --last;
+    }
+}
+
+} // namespace detail
+} // namespace ptree_utils
+
+/**
+ * @brief Locale-free translator between strings and arithmetic values.
+ *        Parsing uses std::from_chars and formatting uses std::to_chars,
+ *        which for floating point values yields the shortest string that
+ *        round-trips. Unlike boost::property_tree::stream_translator, no
+ *        stream or locale is constructed per conversion.
+ *
+ *        Pass it explicitly, e.g. pt.get<int>("a.b", FastTranslator<int>()),
+ *        or see PTREE_UTILS_FAST_TRANSLATOR_DEFAULT below.
+ *
+ *        Surrounding whitespace and a leading '+' are accepted like the
+ *        stream translator does. Like the stream translator, "inf" and
+ *        "nan" are rejected, even though non-finite values are written
+ *        that way. Unlike the stream translator, values that do not fit
+ *        are rejected rather than converted, i.e. negative values for
+ *        unsigned types (e.g. "-1") and floating point values that
+ *        overflow or underflow (e.g. "1e-50" as float).
+ */
+template<typename T>
+struct FastTranslator
+{
+    static_assert(std::is_arithmetic<T>::value,
+                  "FastTranslator requires an arithmetic type");
+
+    typedef std::string internal_type;
+    typedef T           external_type;
+
+    // Converts a string to a number.
+    boost::optional<external_type> get_value(const internal_type& s) const
+    {
+        const char* first = s.data();
+        const char* last = s.data() + s.size();
+        ptree_utils::detail::trimWhitespace(first, last);
+        if (last - first > 1 && *first == '+' &&
+            (isDigit(first[1]) || first[1] == '.'))
+        {   // Accepted by streams, but not by from_chars.
+            ++first;
+        }
+
+        // Only allow numbers to start with a digit or a decimal point,
+        // which rules out the "inf" and "nan" accepted by from_chars.
+        const char* digits = first != last && *first == '-' ? first + 1 : first;
+        if (digits == last || !(isDigit(*digits) || *digits == '.'))
+        {
+            return boost::optional<external_type>();
+        }
+
+        external_type value;
+        const auto result = std::from_chars(first, last, value);
+        if (result.ec != std::errc() || result.ptr != last)
+        {
+            return boost::optional<external_type>();
+        }
+        return boost::optional<external_type>(value);
+    }
+
+    // Converts a number to a string.
+    boost::optional<internal_type> put_value(const external_type& value) const
+    {
+        // Large enough for the shortest round-trip representation of any
+        // floating point type, including long double.
+        char buffer[64];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        if (result.ec != std::errc())
+        {
+            return boost::optional<internal_type>();
+        }
+        return boost::optional<internal_type>(internal_type(buffer, result.ptr));
+    }
+
+private:
+    static bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+};
+
+/**
+ * @brief Booleans are written as "true"/"false" and read from
+ *        "true"/"false"/"1"/"0", matching the default stream translator.
+ */
+template<>
+struct FastTranslator<bool>
+{
+    typedef std::string internal_type;
+    typedef bool        external_type;
+
+    // Converts a string to bool.
+    boost::optional<external_type> get_value(const internal_type& s) const
+    {
+        const char* first = s.data();
+        const char* last = s.data() + s.size();
+        ptree_utils::detail::trimWhitespace(first, last);
+        const std::string_view token(first, static_cast<std::size_t>(last - first));
+
+        if (token == "true" || token == "1")
+        {
+            return boost::optional<external_type>(true);
+        }
+        if (token == "false" || token == "0")
+        {
+            return boost::optional<external_type>(false);
+        }
+        return boost::optional<external_type>();
+    }
+
+    // Converts a bool to string.
+    boost::optional<internal_type> put_value(const external_type& b) const
+    {
+        return boost::optional<internal_type>(b ? "true" : "false");
+    }
+};
+
+namespace ptree_utils {
+namespace detail {
+
+/**
+ * @brief Translator the utilities use to read and write values of type
+ *        @a T in trees with data type @a Data, independent of whether
+ *        PTREE_UTILS_FAST_TRANSLATOR_DEFAULT is defined. FastTranslator for
+ *        arithmetic values in string trees, the tree's default otherwise.
+ *        Specialized for other data types next to their translators.
+ */
+template<typename Data, typename T, typename Enable = void>
+struct ValueTranslator
+{
+    typedef typename boost::property_tree::translator_between<Data, T>::type type;
+};
+
+template<typename T>
+struct ValueTranslator<std::string, T,
+                       typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    typedef FastTranslator<T> type;
+};
+
+} // namespace detail
+} // namespace ptree_utils
+
+// Defining PTREE_UTILS_FAST_TRANSLATOR_DEFAULT makes FastTranslator the
+// default translator for std::string data and the supported value types,
+// so pt.get<int>("a.b") uses it without passing it explicitly.
+//
+// This changes what basic_ptree::get<T> etc. compile to, so the macro
+// must be defined in every translation unit of the program, before any
+// Boost property tree header is included. Otherwise the same function gets
+// different bodies in different translation units (an ODR violation). Use
+// the PTREE_UTILS_FAST_TRANSLATOR_DEFAULT CMake option, which defines it
+// for the whole project.
+#ifdef PTREE_UTILS_FAST_TRANSLATOR_DEFAULT
+
+#define PTREE_UTILS_FAST_TRANSLATOR(T)                                        \
+    template<>                                                                \
+    struct translator_between<std::string, T>                                 \
+    {                                                                         \
+        typedef FastTranslator<T> type;                                       \
+    };
+
+namespace boost {
+namespace property_tree {
+
+PTREE_UTILS_FAST_TRANSLATOR(bool)
+PTREE_UTILS_FAST_TRANSLATOR(short)
+PTREE_UTILS_FAST_TRANSLATOR(unsigned short)
+PTREE_UTILS_FAST_TRANSLATOR(int)
+PTREE_UTILS_FAST_TRANSLATOR(unsigned int)
+PTREE_UTILS_FAST_TRANSLATOR(long)
+PTREE_UTILS_FAST_TRANSLATOR(unsigned long)
+PTREE_UTILS_FAST_TRANSLATOR(long long)
+PTREE_UTILS_FAST_TRANSLATOR(unsigned long long)
+PTREE_UTILS_FAST_TRANSLATOR(float)
+PTREE_UTILS_FAST_TRANSLATOR(double)
+PTREE_UTILS_FAST_TRANSLATOR(long double)
+
+} // namespace property_tree
+} // namespace boost
+
+#undef PTREE_UTILS_FAST_TRANSLATOR
+
+#endif // PTREE_UTILS_FAST_TRANSLATOR_DEFAULT
+
+#endif // PTREE_TRANSLATORS_HPP_INCLUDED
@@ -1,11 +1,20 @@
 #ifndef PTREE_UTILS_HPP_INCLUDED
 #define PTREE_UTILS_HPP_INCLUDED
 
+#include <cstddef>
 #include <iostream>
+#include <queue>
+#include <set>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include "PTreeStats.hpp"
+
 namespace std {
 
 template<class K, class D, class C>
@@ -18,14 +27,157 @@ ostream& operator<<(
 
 } // namespace std
 
+namespace ptree_utils {
+namespace detail {
+
+/**
+ * @brief Copy the structure of @a src into @a dst, translating each value
+ *        from the key type (i.e. string) into the data type of @a dst.
+ */
+template<class K, class D, class C>
+void translateTree(const boost::property_tree::basic_ptree<K, K, C>& src,
+                   boost::property_tree::basic_ptree<K, D, C>& dst)
+{
+    dst.put_value(src.data());
+    const auto iend = src.end();
+    for (auto iter = src.begin(); iter != iend; ++iter)
+    {
+        auto& child = dst.push_back(std::make_pair(
+            iter->first, boost::property_tree::basic_ptree<K, D, C>()))->second;
+        translateTree(iter->second, child); // Recursive!
+    }
+}
+
+template<class K, class C>
+void readJson(std::istream& is, boost::property_tree::basic_ptree<K, K, C>& pt)
+{
+    boost::property_tree::read_json(is, pt);
+}
+
+/**
+ * @brief The JSON parser can only produce trees with string data, so
+ *        trees with custom data (e.g. MyPTree) are parsed into a string
+ *        tree first and then translated.
+ */
+template<class K, class D, class C>
+void readJson(std::istream& is, boost::property_tree::basic_ptree<K, D, C>& pt)
+{
+    boost::property_tree::basic_ptree<K, K, C> string_tree;
+    boost::property_tree::read_json(is, string_tree);
+    boost::property_tree::basic_ptree<K, D, C> translated;
+    translateTree(string_tree, translated);
+    pt.swap(translated);
+}
+
+/**
+ * @brief Count @a tree and all its (direct and indirect) children.
+ */
+template<class K, class D, class C>
+std::size_t countNodes(const boost::property_tree::basic_ptree<K, D, C>& tree)
+{
+    std::size_t count = 1;
+    const auto iend = tree.end();
+    for (auto iter = tree.begin(); iter != iend; ++iter)
+    {
+        count += countNodes(iter->second); // Recursive!
+    }
+    return count;
+}
+
+/**
+ * @brief Key of a traversed child, or its index if it is an array element.
+ *        A stack of these describes the current position in a traversal
+ *        without building path strings.
+ */
+template<class K>
+struct PathElement
+{
+    const K* key;
+    std::size_t index;
+};
+
+/**
+ * @brief Format @a path as "a.b[i]", the notation used by untouchedKeys().
+ */
+template<class K>
+std::string dumpPath(const std::vector<PathElement<K>>& path)
+{
+    std::stringstream ss;
+    for (std::size_t i = 0; i < path.size(); ++i)
+    {
+        if (path[i].key->empty())
+        {
+            ss << "[" << path[i].index << "]";
+        }
+        else
+        {
+            if (i > 0)
+            {
+                ss << ".";
+            }
+            ss << *path[i].key;
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Same as @a tree.put_child(@a path, @a value), i.e. intermediate
+ *        keys are created as needed and the first child matching the last
+ *        key is replaced.
+ * @return True if an existing child was replaced, false if one was added.
+ */
+template<class K, class D, class C>
+bool putChild(boost::property_tree::basic_ptree<K, D, C>& tree,
+              typename boost::property_tree::basic_ptree<K, D, C>::path_type path,
+              const boost::property_tree::basic_ptree<K, D, C>& value)
+{
+    typedef boost::property_tree::basic_ptree<K, D, C> tree_type;
+
+    tree_type* parent = &tree;
+    K key = path.reduce();
+    while (!path.empty())
+    {
+        auto iter = parent->find(key);
+        if (iter == parent->not_found())
+        {
+            parent = &parent->push_back(std::make_pair(key, tree_type()))->second;
+        }
+        else
+        {
+            parent = &iter->second;
+        }
+        key = path.reduce();
+    }
+
+    auto iter = parent->find(key);
+    if (iter != parent->not_found())
+    {
+        iter->second = value;
+        return true;
+    }
+    parent->push_back(std::make_pair(key, value));
+    return false;
+}
+
+} // namespace detail
+} // namespace ptree_utils
+
 template<class K, class D, class C>
 void readJsonString(
         const char* json_data,
         boost::property_tree::basic_ptree<K, D, C>& pt)
 {
-    std::stringstream ss;
-    ss << json_data;
-    boost::property_tree::read_json(ss, pt);
+    {
+        PTREE_STATS_SCOPE(PTREE_OP_READ_JSON);
+
+        std::stringstream ss;
+        ss << json_data;
+        ptree_utils::detail::readJson(ss, pt);
+    }
+
+    // Counted after the timed scope, so the count is not part of the time.
+    PTREE_STATS_NODES(PTREE_OP_READ_JSON, ptree_utils::detail::countNodes(pt));
 }
 
 /**
@@ -115,6 +267,9 @@ bool hasUniquePaths(const boost::property_tree::ptree& pt)
 {
     using boost::property_tree::ptree;
 
+    PTREE_STATS_SCOPE(PTREE_OP_HAS_UNIQUE_PATHS);
+    PTREE_STATS_NODES(PTREE_OP_HAS_UNIQUE_PATHS, 1);
+
     if (!hasUniqueKeys(pt))
     {
         return false;
@@ -141,6 +296,8 @@ boost::property_tree::ptree merge(const boost::property_tree::ptree& pt1,
     using namespace std;
     using boost::property_tree::ptree;
 
+    PTREE_STATS_SCOPE(PTREE_OP_MERGE);
+
     // Initialize to merge result to first tree.
     ptree merged = pt1;
 
@@ -163,10 +320,14 @@ boost::property_tree::ptree merge(const boost::property_tree::ptree& pt1,
 
             const ptree::path_type sub_path = path / ptree::path_type(sub_key);
 
+            PTREE_STATS_NODES(PTREE_OP_MERGE, 1);
+
             if (isLeafTree(sub_tree) || isArrayTree(sub_tree))
             {
                 // Put sub-tree into merged property tree.
-                merged.put_child(sub_path, sub_tree);
+                const bool replaced =
+                    ptree_utils::detail::putChild(merged, sub_path, sub_tree);
+                PTREE_STATS_LOOKUP(PTREE_OP_MERGE, replaced);
             }
             else
             {
@@ -0,0 +1,764 @@
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/stream_translator.hpp>
+
+#include "MyPTree.hpp"
+#include "PTreeGenerator.hpp"
+#include "PTreeQuery.hpp"
+#include "PTreeSchema.hpp"
+#include "PTreeStreamMerge.hpp"
+#include "PTreeTranslators.hpp"
+#include "PTreeUtils.hpp"
+
+namespace {
+
+// Prevent the optimizer from discarding benchmark results.
+volatile std::size_t sink = 0;
+
+template<typename T>
+using StreamTranslator = boost::property_tree::stream_translator<
+    char, std::char_traits<char>, std::allocator<char>, T>;
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::size_t iterations;
+    double ns_per_op;
+};
+
+/**
+ * @brief Runs @a f in batches until at least @a min_seconds have passed,
+ *        so that fast and slow operations both get stable timings.
+ */
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const double min_seconds)
+            : min_seconds_(min_seconds) {
+    }
+
+    void run(const std::string& name, const std::function<void()>& f)
+    {
+        using namespace std::chrono;
+
+        f(); // Warm up.
+
+        std::size_t iterations = 0;
+        std::size_t batch = 1;
+        double ns = 0.0;
+        // At least one batch, so that --min-time 0 still gives a result.
+        do
+        {
+            const auto start = steady_clock::now();
+            for (std::size_t i = 0; i < batch; ++i)
+            {
+                f();
+            }
+            const auto stop = steady_clock::now();
+            ns += duration<double, std::nano>(stop - start).count();
+            iterations += batch;
+            batch *= 2;
+        }
+        while (ns < min_seconds_ * 1e9);
+
+        const BenchmarkResult result = { name, iterations, ns / iterations };
+        results_.push_back(result);
+    }
+
+    const std::vector<BenchmarkResult>& results() const {
+        return results_;
+    }
+
+private:
+    double min_seconds_;
+    std::vector<BenchmarkResult> results_;
+};
+
+struct BenchOptions
+{
+    GeneratorOptions generator;
+    std::string format = "text";
+    double min_seconds = 0.2;
+    bool verify = false;
+};
+
+void usage(std::ostream& os)
+{
+    os << "Usage: ptree-bench [options]\n"
+       << "  --format text|csv|json   Output format (default: text)\n"
+       << "  --depth N                Object levels (default: 4)\n"
+       << "  --fan-out N              Children per object (default: 8)\n"
+       << "  --array-size N           Array elements per object (default: 4)\n"
+       << "  --duplicates R           Key duplication ratio in [0, 1] (default: 0)\n"
+       << "  --seed N                 Generator seed (default: 42)\n"
+       << "  --min-time S             Minimum seconds per benchmark (default: 0.2)\n"
+       << "  --verify                 Check the utilities against expected\n"
+       << "                           results instead of benchmarking\n";
+}
+
+// The whole of @a value must parse, values like "abc" or "4x" are rejected.
+bool parseUnsigned(const char* value, unsigned long long& out)
+{
+    if (*value == '\0' || *value == '-')
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    out = std::strtoull(value, &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+bool parseSize(const char* value, std::size_t& out)
+{
+    unsigned long long parsed = 0;
+    if (!parseUnsigned(value, parsed) ||
+        parsed > std::numeric_limits<std::size_t>::max())
+    {
+        return false;
+    }
+    out = static_cast<std::size_t>(parsed);
+    return true;
+}
+
+bool parseDouble(const char* value, const double min, const double max,
+                 double& out)
+{
+    if (*value == '\0')
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    out = std::strtod(value, &end);
+    return *end == '\0' && errno == 0 && min <= out && out <= max;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--verify")
+        {
+            options.verify = true;
+            continue;
+        }
+        if (arg == "--help" || i + 1 >= argc)
+        {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--format")
+        {
+            options.format = value;
+            if (options.format != "text" && options.format != "csv" &&
+                options.format != "json")
+            {
+                return false;
+            }
+        }
+        else if (arg == "--depth")
+        {
+            if (!parseSize(value, options.generator.depth))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--fan-out")
+        {
+            if (!parseSize(value, options.generator.fan_out))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--array-size")
+        {
+            if (!parseSize(value, options.generator.array_size))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--duplicates")
+        {
+            if (!parseDouble(value, 0.0, 1.0, options.generator.duplicate_ratio))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--seed")
+        {
+            unsigned long long seed = 0;
+            if (!parseUnsigned(value, seed))
+            {
+                return false;
+            }
+            options.generator.seed = seed;
+        }
+        else if (arg == "--min-time")
+        {
+            if (!parseDouble(value, 0.0, std::numeric_limits<double>::max(),
+                             options.min_seconds))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void benchmarkTranslators(BenchmarkRunner& runner, const std::string& type_name,
+                          const T value)
+{
+    using boost::property_tree::ptree;
+
+    ptree pt;
+    pt.put("value", value);
+    const T other = static_cast<T>(value + static_cast<T>(1));
+
+    runner.run("get<" + type_name + ">/stream", [&]() {
+        sink += static_cast<std::size_t>(
+            pt.get<T>("value", StreamTranslator<T>()));
+    });
+    runner.run("get<" + type_name + ">/fast", [&]() {
+        sink += static_cast<std::size_t>(
+            pt.get<T>("value", FastTranslator<T>()));
+    });
+    runner.run("put<" + type_name + ">/stream", [&]() {
+        pt.put("value", other, StreamTranslator<T>());
+    });
+    runner.run("put<" + type_name + ">/fast", [&]() {
+        pt.put("value", other, FastTranslator<T>());
+    });
+}
+
+// Fields of a generated tree, see generatedSchema().
+struct GeneratedConfig
+{
+    std::string first;
+    std::string last;
+    std::vector<std::string> array;
+    int missing;
+};
+
+// Path of the leaf reached by taking child @a i at every level.
+std::string generatedPath(const GeneratorOptions& options, const std::size_t i)
+{
+    std::stringstream ss;
+    for (std::size_t level = 0; level < options.depth; ++level)
+    {
+        ss << (level > 0 ? "." : "") << "key_" << level << "_" << i;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Schema for the first and last leaf and the top-level array of a
+ *        generated tree. All other keys are reported as unknown.
+ */
+template<class Tree>
+PTreeSchema<GeneratedConfig, Tree> generatedSchema(const GeneratorOptions& options)
+{
+    PTreeSchema<GeneratedConfig, Tree> schema;
+    if (options.depth > 0 && options.fan_out > 0)
+    {
+        schema.required(generatedPath(options, 0), &GeneratedConfig::first);
+        if (options.fan_out > 1)
+        {
+            schema.required(generatedPath(options, options.fan_out - 1),
+                            &GeneratedConfig::last);
+        }
+    }
+    schema.optional("array_0", &GeneratedConfig::array, std::vector<std::string>())
+          .optional("missing", &GeneratedConfig::missing, 0);
+    return schema;
+}
+
+void benchmarkUtils(BenchmarkRunner& runner, const GeneratorOptions& options)
+{
+    using boost::property_tree::ptree;
+
+    const ptree base = generateTree(options);
+
+    GeneratorOptions override_options = options;
+    override_options.seed = options.seed + 1;
+    override_options.fan_out = options.fan_out > 1 ? options.fan_out / 2 : 1;
+    const ptree overrides = generateTree(override_options);
+
+    std::stringstream json;
+    boost::property_tree::write_json(json, base, false);
+    const std::string json_data = json.str();
+
+    std::stringstream overrides_json;
+    boost::property_tree::write_json(overrides_json, overrides, false);
+    const std::string overrides_data = overrides_json.str();
+
+    // PTreeUtils.hpp
+    runner.run("isLeafTree", [&]() {
+        sink += isLeafTree(base);
+    });
+    runner.run("isEmptyTree", [&]() {
+        sink += isEmptyTree(base);
+    });
+    // The last child of each generated object is its array, if any.
+    const ptree& array = base.empty() ? base : base.back().second;
+    runner.run("isArrayTree", [&]() {
+        sink += isArrayTree(array);
+    });
+    runner.run("hasUniqueKeys", [&]() {
+        sink += hasUniqueKeys(base);
+    });
+    runner.run("hasUniquePaths", [&]() {
+        sink += hasUniquePaths(base);
+    });
+    runner.run("merge", [&]() {
+        sink += merge(base, overrides).size();
+    });
+    runner.run("readJsonString+merge", [&]() {
+        ptree pt;
+        readJsonString(overrides_data.c_str(), pt);
+        sink += merge(base, pt).size();
+    });
+
+    // PTreeQuery.hpp
+    std::vector<PTreeQuery> queries;
+    queries.push_back(PTreeQuery(generatedPath(options, 0)));
+    queries.push_back(PTreeQuery("*.key_1_1"));
+    queries.push_back(PTreeQuery("**.array_1[1:3]"));
+    queries.push_back(PTreeQuery("key_0_0.**.key_2_0"));
+    queries.push_back(PTreeQuery("array_0[*]"));
+    runner.run("queryTree/single", [&]() {
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            sink += queryTree(base, queries[i]).size();
+        }
+    });
+    runner.run("queryTree/multi", [&]() {
+        sink += queryTree(base, queries).size();
+    });
+
+    // PTreeSchema.hpp
+    const auto schema = generatedSchema<ptree>(options);
+    runner.run("PTreeSchema::bind", [&]() {
+        GeneratedConfig config;
+        sink += schema.bind(base, config).unknown.size();
+    });
+
+    // PTreeStreamMerge.hpp
+    runner.run("mergeJsonString", [&]() {
+        ptree pt = base;
+        mergeJsonString(pt, overrides_data.c_str());
+        sink += pt.size();
+    });
+
+    runner.run("readJsonString", [&]() {
+        ptree pt;
+        readJsonString(json_data.c_str(), pt);
+        sink += pt.size();
+    });
+    runner.run("write_json", [&]() {
+        std::stringstream ss;
+        boost::property_tree::write_json(ss, base, false);
+        sink += ss.str().size();
+    });
+
+    // MyPTree.hpp
+    runner.run("readJsonString<MyPTree>", [&]() {
+        MyPTree pt;
+        readJsonString(json_data.c_str(), pt);
+        sink += pt.size();
+    });
+
+    MyPTree my_pt;
+    readJsonString(json_data.c_str(), my_pt);
+    const auto my_schema = generatedSchema<MyPTree>(options);
+    runner.run("PTreeSchema<MyPTree>::bind", [&]() {
+        GeneratedConfig config;
+        sink += my_schema.bind(my_pt, config).unknown.size();
+    });
+    runner.run("untouchedKeys", [&]() {
+        sink += untouchedKeys(my_pt).size();
+    });
+    runner.run("accessProfile", [&]() {
+        sink += accessProfile(my_pt).size();
+    });
+    runner.run("topAccessedKeys", [&]() {
+        sink += topAccessedKeys(my_pt, 10).size();
+    });
+}
+
+// Print @a what to stderr unless @a condition holds.
+bool expect(const bool condition, const std::string& what)
+{
+    if (!condition)
+    {
+        std::cerr << "check failed: " << what << std::endl;
+    }
+    return condition;
+}
+
+// Paths of the matches of @a query in @a pt.
+std::vector<std::string> queryPaths(const boost::property_tree::ptree& pt,
+                                    const std::string& query)
+{
+    const auto matches = queryTree(pt, PTreeQuery(query));
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < matches.size(); ++i)
+    {
+        paths.push_back(matches[i].path);
+    }
+    return paths;
+}
+
+bool isInvalidQuery(const std::string& query)
+{
+    try
+    {
+        PTreeQuery q(query);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Evaluate queries of every kind of step on a small document, and
+ *        check that evaluating them together gives the same matches as
+ *        one at a time.
+ * @return The number of failed checks.
+ */
+std::size_t verifyQuery()
+{
+    typedef std::vector<std::string> Paths;
+
+    boost::property_tree::ptree pt;
+    readJsonString("{\"a\":{\"b\":1,\"c\":{\"b\":2}},"
+                   "\"stages\":[{\"x\":1},{\"x\":2},{\"x\":3}],"
+                   "\"n\":[10,20,30,40]}", pt);
+
+    const std::pair<const char*, Paths> cases[] = {
+        { "", Paths(1, "") },
+        { "a.b", Paths(1, "a.b") },
+        { "a.*", Paths({"a.b", "a.c"}) },
+        { "**.b", Paths({"a.b", "a.c.b"}) },
+        { "a.**.b", Paths({"a.b", "a.c.b"}) },
+        { "**.**.c", Paths(1, "a.c") },
+        { "stages[1].x", Paths(1, "stages[1].x") },
+        { "stages.[1].x", Paths(1, "stages[1].x") },
+        { "stages[*].x", Paths({"stages[0].x", "stages[1].x", "stages[2].x"}) },
+        { "n[1:3]", Paths({"n[1]", "n[2]"}) },
+        { "n[:2]", Paths({"n[0]", "n[1]"}) },
+        { "n[2:]", Paths({"n[2]", "n[3]"}) },
+        { "n[4]", Paths() },
+        { "n[18446744073709551614]", Paths() },
+        { "a[0]", Paths() },
+        { "*.x", Paths() }
+    };
+
+    std::size_t failures = 0;
+    std::vector<PTreeQuery> queries;
+    for (std::size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        failures += !expect(queryPaths(pt, cases[i].first) == cases[i].second,
+                            std::string("query '") + cases[i].first + "'");
+        queries.push_back(PTreeQuery(cases[i].first));
+    }
+
+    const auto matches = queryTree(pt, queries);
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        Paths paths;
+        for (std::size_t j = 0; j < matches[i].size(); ++j)
+        {
+            paths.push_back(matches[i][j].path);
+        }
+        failures += !expect(paths == cases[i].second,
+                            "query '" + queries[i].str() + "' with others");
+    }
+
+    const char* const invalid[] = {
+        "a..b", ".a", "a.", "a*", "**[0]", "n[1", "n]", "n[x]", "n[-1]",
+        "n[1:x]", "n[]",
+        "n[18446744073709551615]",   // SIZE_MAX, end of slice overflows.
+        "n[99999999999999999999999]"
+    };
+    for (std::size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        failures += !expect(isInvalidQuery(invalid[i]),
+                            std::string("invalid query '") + invalid[i] + "'");
+    }
+    return failures;
+}
+
+/**
+ * @brief Folded stacks keep keys that contain '.', ';' or '[' as a single
+ *        frame.
+ * @return The number of failed checks.
+ */
+std::size_t verifyAccessProfile()
+{
+    MyPTree pt;
+    readJsonString("{\"a.b\":1,\"x;y\":2,\"c[1]\":3,\"n\":[4,5]}", pt);
+    pt.front().second.get_value<int>(MyDataTranslator<int>());
+
+    std::stringstream folded;
+    writeAccessProfileFolded(folded, pt);
+    return !expect(folded.str() == "a.b 1\nx%3By 0\nc[1] 0\nn;[0] 0\nn;[1] 0\n",
+                   "folded access profile");
+}
+
+struct SchemaConfig
+{
+    int index;
+    double dt;
+    bool enabled;
+    std::string name;
+    std::vector<int> stages;
+    long fallback;
+};
+
+/**
+ * @brief Bind valid and invalid documents into SchemaConfig from a tree
+ *        with data type of @a Tree.
+ * @return The number of failed checks.
+ */
+template<class Tree>
+std::size_t verifySchema(const std::string& tree_name)
+{
+    PTreeSchema<SchemaConfig, Tree> schema;
+    schema.required("frame.index", &SchemaConfig::index)
+          .optional("frame.dt", &SchemaConfig::dt, 0.16)
+          .required("frame.enabled", &SchemaConfig::enabled)
+          .optional("name", &SchemaConfig::name, std::string("default"))
+          .required("stages", &SchemaConfig::stages)
+          .optional("fallback", &SchemaConfig::fallback, 3L);
+
+    std::size_t failures = 0;
+
+    Tree valid;
+    readJsonString("{\"frame\":{\"index\":\" 7\",\"dt\":0.5,\"enabled\":true},"
+                   "\"name\":\"x\",\"stages\":[1,2,3],\"extra\":{\"a\":1}}", valid);
+    SchemaConfig config;
+    SchemaReport report = schema.bind(valid, config);
+    failures += !expect(report.ok(), tree_name + ": valid document binds");
+    failures += !expect(config.index == 7 && config.dt == 0.5 && config.enabled &&
+                        config.name == "x" && config.fallback == 3,
+                        tree_name + ": scalar values");
+    failures += !expect(config.stages == std::vector<int>({1, 2, 3}),
+                        tree_name + ": array values");
+    failures += !expect(report.unknown == std::vector<std::string>(1, "extra"),
+                        tree_name + ": unknown keys");
+
+    Tree invalid;
+    readJsonString("{\"frame\":{\"index\":\"x\"},\"frame\":{\"index\":2},"
+                   "\"stages\":[1,\"y\"]}", invalid);
+    report = schema.bind(invalid, config);
+    failures += !expect(!report.ok(), tree_name + ": invalid document fails");
+    failures += !expect(report.missing == std::vector<std::string>(1, "frame.enabled"),
+                        tree_name + ": missing fields");
+    failures += !expect(report.invalid == std::vector<std::string>({"frame.index", "stages"}),
+                        tree_name + ": invalid fields");
+    failures += !expect(report.duplicate == std::vector<std::string>(1, "frame.index"),
+                        tree_name + ": duplicate fields");
+    return failures;
+}
+
+// Both merges of @a overrides_data into @a base must give the same tree,
+// including the order of keys.
+bool verifyMerge(const boost::property_tree::ptree& base,
+                 const std::string& overrides_data)
+{
+    using boost::property_tree::ptree;
+
+    ptree overrides;
+    readJsonString(overrides_data.c_str(), overrides);
+    const ptree expected = merge(base, overrides);
+
+    ptree streamed = base;
+    mergeJsonString(streamed, overrides_data.c_str());
+
+    if (streamed != expected)
+    {
+        std::cerr << "mergeJsonString differs from merge for overrides "
+                  << overrides_data << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compare mergeJsonString() with merge() for pairs of generated
+ *        trees of varying shape, so that overrides both replace existing
+ *        values and add new objects at different depths.
+ * @return The number of mismatches.
+ */
+std::size_t verifyStreamMerge(const GeneratorOptions& options)
+{
+    using boost::property_tree::ptree;
+
+    const std::size_t runs = 200;
+    std::size_t failures = 0;
+
+    // Base and override documents.
+    const std::pair<const char*, const char*> cases[] = {
+        { "{\"a\":[1,2],\"b\":{\"c\":1},\"d\":{\"e\":{\"f\":1}}}", "{}" },
+        { "{\"a\":[1,2],\"b\":{\"c\":1},\"d\":{\"e\":{\"f\":1}}}", "5" },
+        { "{\"a\":[1,2],\"b\":{\"c\":1},\"d\":{\"e\":{\"f\":1}}}",
+          "{\"a\":[3],\"b\":{},\"n\":{}}" },
+        { "{\"a\":[1,2],\"b\":{\"c\":1},\"d\":{\"e\":{\"f\":1}}}",
+          "{\"n\":{\"o\":{\"p\":1},\"q\":2},\"b\":{\"c\":\"x\",\"g\":null}}" },
+        { "{\"a\":[1,2],\"b\":{\"c\":1},\"d\":{\"e\":{\"f\":1}}}",
+          "{\"d\":{\"e\":{\"n\":{\"o\":true}},\"m\":[[1],{\"x\":1}]},\"z\":1}" },
+        // Objects whose keys are all empty are arrays to merge().
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"\":1}}" },
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"y\":{\"\":[1]}}}" },
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"\":{\"y\":1},\"\":{\"z\":2}}}" },
+        { "{\"a\":{\"x\":1}}", "{\"n\":{\"\":1,\"\":[2]},\"m\":{\"o\":{\"\":3}}}" },
+        // An empty key followed by others is a member of the object.
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"\":1,\"y\":2}}" },
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"\":{\"y\":{\"z\":1}},\"w\":2}}" },
+        { "{\"a\":{\"x\":1}}", "{\"n\":{\"\":{\"y\":1},\"w\":{\"\":2}}}" },
+        { "{\"a\":{\"x\":1}}", "{\"a\":{\"w\":1,\"\":{\"y\":1,\"z\":[2]},\"v\":3}}" },
+        { "{}", "{\"y\":[5],\"\":{\"x\":[3]},\"z\":3,\"w\":{}}" }
+    };
+    for (std::size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        ptree base;
+        readJsonString(cases[i].first, base);
+        failures += !verifyMerge(base, cases[i].second);
+    }
+
+    for (std::size_t run = 0; run < runs; ++run)
+    {
+        GeneratorOptions base_options = options;
+        base_options.depth = 1 + run % 4;
+        base_options.fan_out = 1 + run % 5;
+        base_options.array_size = run % 3;
+        base_options.seed = options.seed + run;
+        // Key order only matches for unique paths, see mergeJson().
+        base_options.duplicate_ratio = 0.0;
+
+        GeneratorOptions override_options = base_options;
+        override_options.depth = 1 + (run / 3) % 5;
+        override_options.fan_out = 1 + (run / 7) % 6;
+        override_options.seed = base_options.seed + runs;
+
+        std::stringstream json;
+        boost::property_tree::write_json(json, generateTree(override_options), false);
+        failures += !verifyMerge(generateTree(base_options), json.str());
+    }
+    return failures;
+}
+
+void writeResults(std::ostream& os, const BenchOptions& options,
+                  const std::size_t nodes,
+                  const std::vector<BenchmarkResult>& results)
+{
+    const GeneratorOptions& g = options.generator;
+
+    if (options.format == "csv")
+    {
+        os << "name,iterations,ns_per_op,depth,fan_out,array_size,"
+           << "duplicate_ratio,seed,nodes\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            os << "\"" << results[i].name << "\"," << results[i].iterations
+               << "," << results[i].ns_per_op << "," << g.depth << ","
+               << g.fan_out << "," << g.array_size << "," << g.duplicate_ratio
+               << "," << g.seed << "," << nodes << "\n";
+        }
+    }
+    else if (options.format == "json")
+    {
+        os << "{\n"
+           << "  \"generator\": {\"depth\": " << g.depth
+           << ", \"fan_out\": " << g.fan_out
+           << ", \"array_size\": " << g.array_size
+           << ", \"duplicate_ratio\": " << g.duplicate_ratio
+           << ", \"seed\": " << g.seed
+           << ", \"nodes\": " << nodes << "},\n"
+           << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            os << "    {\"name\": \"" << results[i].name
+               << "\", \"iterations\": " << results[i].iterations
+               << ", \"ns_per_op\": " << results[i].ns_per_op << "}"
+               << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        os << "  ]\n"
+           << "}\n";
+    }
+    else
+    {
+        os << "Generated tree: " << nodes << " nodes" << std::endl;
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            os << results[i].name << ": " << results[i].ns_per_op
+               << " ns/op (" << results[i].iterations << " iterations)\n";
+        }
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        usage(std::cerr);
+        return 1;
+    }
+
+    if (options.verify)
+    {
+        const std::size_t merge_failures = verifyStreamMerge(options.generator);
+        std::cout << "mergeJsonString: " << merge_failures << " failures" << std::endl;
+        const std::size_t schema_failures =
+            verifySchema<boost::property_tree::ptree>("ptree") +
+            verifySchema<MyPTree>("MyPTree");
+        std::cout << "PTreeSchema: " << schema_failures << " failures" << std::endl;
+        const std::size_t query_failures = verifyQuery();
+        std::cout << "queryTree: " << query_failures << " failures" << std::endl;
+        const std::size_t profile_failures = verifyAccessProfile();
+        std::cout << "accessProfile: " << profile_failures << " failures" << std::endl;
+        return merge_failures + schema_failures + query_failures +
+               profile_failures == 0 ? 0 : 1;
+    }
+
+    BenchmarkRunner runner(options.min_seconds);
+
+    benchmarkTranslators<int>(runner, "int", 123456);
+    benchmarkTranslators<long long>(runner, "long long", -9876543210LL);
+    benchmarkTranslators<float>(runner, "float", 3.14159f);
+    benchmarkTranslators<double>(runner, "double", 2.718281828459045);
+    benchmarkTranslators<bool>(runner, "bool", true);
+
+    benchmarkUtils(runner, options.generator);
+
+    const std::size_t nodes = ptree_utils::detail::countNodes(generateTree(options.generator));
+    writeResults(std::cout, options, nodes, runner.results());
+
+    return 0;
+}
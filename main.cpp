@@ -11,10 +11,10 @@
 #include <set>
 
 #include "MyPTree.hpp"
+#include "PTreeStats.hpp"
 #include "PTreeUtils.hpp"
 
 
-
 #if 0
 class Config
 {
@@ -445,6 +445,18 @@ main(int argc, char* argv[])
                     cout << *iter << endl;
                 }
             }
+
+#ifdef PTREE_UTILS_ENABLE_STATS
+            const PTreeStats stats = ptreeStats();
+            cout << "readJsonString: " << stats.read_json.calls << " calls, "
+                 << stats.read_json.nodes_visited << " nodes, "
+                 << stats.read_json.bytes_allocated << " bytes, "
+                 << stats.read_json.nanoseconds << " ns" << endl;
+            cout << "untouchedKeys: " << stats.untouched_keys.calls << " calls, "
+                 << stats.untouched_keys.nodes_visited << " nodes, "
+                 << stats.untouched_keys.lookup_hits << "/"
+                 << stats.untouched_keys.lookups << " touched" << endl;
+#endif
         }
 #endif
     }